@@ -0,0 +1,452 @@
+#include "concavehullengine.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+
+class ConcaveHullEngine::SearchPool
+{
+public:
+    SearchPool()
+        : m_engine(nullptr)
+        , m_stopping(false)
+    {
+        const int count = std::max(1, QThread::idealThreadCount());
+        m_workers.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            Worker *worker = new Worker(this, i);
+            worker->start();
+            m_workers.append(worker);
+        }
+    }
+
+    ~SearchPool()
+    {
+        m_stopping = true;
+        for (Worker *worker : m_workers) {
+            worker->wake.release();
+        }
+        for (Worker *worker : m_workers) {
+            worker->wait();
+        }
+        qDeleteAll(m_workers);
+    }
+
+    int threadCount() const
+    {
+        return m_workers.size();
+    }
+
+    //один шаг поиска движка на всех потоках; шаги разных движков идут по очереди
+    void search(ConcaveHullEngine *engine)
+    {
+        QMutexLocker locker(&m_stepMutex);
+        m_engine = engine;
+        for (Worker *worker : m_workers) {
+            worker->wake.release();
+        }
+        m_done.acquire(m_workers.size());
+    }
+
+private:
+    class Worker : public QThread
+    {
+    public:
+        Worker(SearchPool *pool, int index)
+            : m_pool(pool)
+            , m_index(index)
+        {
+        }
+
+        QSemaphore wake; //разрешение на обработку очередного участка
+
+    protected:
+        void run() override
+        {
+            while (true) {
+                wake.acquire();
+                if (m_pool->m_stopping) {
+                    return;
+                }
+
+                m_pool->m_engine->searchChunk(m_index);
+                m_pool->m_done.release();
+            }
+        }
+
+    private:
+        SearchPool *m_pool;
+        int m_index;
+    };
+
+    QVector<Worker *> m_workers;
+    QSemaphore m_done;                //сигнал о завершении участка потоком
+    QMutex m_stepMutex;               //сериализует шаги разных движков
+    ConcaveHullEngine *m_engine;      //движок текущего шага
+    bool m_stopping;
+};
+
+ConcaveHullEngine::SearchPool &ConcaveHullEngine::searchPool()
+{
+    static SearchPool pool;
+    return pool;
+}
+
+ConcaveHullEngine::ConcaveHullEngine()
+    : m_numThreads(searchPool().threadCount())
+    , m_searchGamma(0.0)
+{
+    m_threadResults.resize(m_numThreads);
+}
+
+void ConcaveHullEngine::searchChunk(int index)
+{
+    ThreadResult &result = m_threadResults[index];
+    findBestPoint(result.begin, result.end, m_searchPb, m_searchPe, m_searchGamma,
+                  result.point, result.area);
+}
+
+bool ConcaveHullEngine::loadPoints(const QString &filename, QVector<QPointF> &points)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    points.clear();
+    QTextStream in(&file);
+
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        if (line.isEmpty()) continue;
+
+        QStringList parts = line.split(" ", Qt::SkipEmptyParts);
+        if (parts.size() >= 2) {
+            bool ok1, ok2;
+            double x = parts[0].toDouble(&ok1);
+            double y = parts[1].toDouble(&ok2);
+
+            if (ok1 && ok2) {
+                points.append(QPointF(x, y));
+            }
+        }
+    }
+
+    file.close();
+    return true;
+}
+
+void ConcaveHullEngine::reserve(int pointCount)
+{
+    m_sortedPoints.reserve(pointCount);
+    m_hull.reserve(pointCount);
+    m_remainingPoints.reserve(pointCount);
+}
+
+qint64 ConcaveHullEngine::bufferBytes() const
+{
+    const qint64 count = m_sortedPoints.capacity() + m_hull.capacity() + m_remainingPoints.capacity();
+    return count * static_cast<qint64>(sizeof(QPointF));
+}
+
+qint64 ConcaveHullEngine::shrink(int pointCount)
+{
+    const qint64 before = bufferBytes();
+    for (QVector<QPointF> *buffer : {&m_sortedPoints, &m_hull, &m_remainingPoints}) {
+        if (buffer->capacity() > pointCount) {
+            QVector<QPointF> smaller;
+            smaller.reserve(pointCount);
+            buffer->swap(smaller);
+        }
+    }
+    return before - bufferBytes();
+}
+
+void ConcaveHullEngine::buildConvexHull(const QVector<QPointF> &points, QVector<QPointF> &convexHull)
+{
+    if (points.size() < 3) {
+        copyInto(points, convexHull);
+        return;
+    }
+
+    grahamScan(points, convexHull);
+}
+
+void ConcaveHullEngine::buildConcaveHull(const QVector<QPointF> &convexHull,
+                                         const QVector<QPointF> &allPoints,
+                                         double gamma,
+                                         QVector<QPointF> &concaveHull)
+{
+    copyInto(convexHull, m_hull);
+
+    //создание множества точек, не входящих в выпуклую оболочку
+    m_remainingPoints.clear();
+    for (const QPointF &point : allPoints) {
+        bool inHull = false;
+        for (const QPointF &hullPoint : convexHull) {
+            if (std::abs(point.x() - hullPoint.x()) < 1e-9 &&
+                std::abs(point.y() - hullPoint.y()) < 1e-9) {
+                inHull = true;
+                break;
+            }
+        }
+        if (!inHull) {
+            m_remainingPoints.append(point);
+        }
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        //нахождение стороны с максимальной длиной
+        int maxSideIndex = 0;
+        double maxLength = 0;
+
+        for (int i = 0; i < m_hull.size(); ++i) {
+            int next = (i + 1) % m_hull.size();
+            double sideLength = distance(m_hull[i], m_hull[next]);
+            if (sideLength > maxLength) {
+                maxLength = sideLength;
+                maxSideIndex = i;
+            }
+        }
+
+        const QPointF pb = m_hull[maxSideIndex];
+        const QPointF pe = m_hull[(maxSideIndex + 1) % m_hull.size()];
+
+        //поиск подходящей точки для создания вогнутости
+        QPointF bestPoint;
+        double minArea = std::numeric_limits<double>::max();
+        bool found = false;
+
+        //многопоточность для поиска лучшей точки
+        if (m_remainingPoints.size() > 100) {
+            //разбиение поиска на участки для общих потоков; потоки
+            //и буферы результатов созданы заранее, шаг ничего не выделяет
+            const int chunkSize = m_remainingPoints.size() / m_numThreads;
+
+            m_searchPb = pb;
+            m_searchPe = pe;
+            m_searchGamma = gamma;
+            for (int i = 0; i < m_numThreads; ++i) {
+                ThreadResult &result = m_threadResults[i];
+                result.begin = i * chunkSize;
+                result.end = (i == m_numThreads - 1) ? m_remainingPoints.size() : (i + 1) * chunkSize;
+                result.area = std::numeric_limits<double>::max();
+            }
+            searchPool().search(this);
+
+            for (int i = 0; i < m_numThreads; ++i) {
+                const ThreadResult &result = m_threadResults[i];
+
+                if (result.area < minArea) {
+                    minArea = result.area;
+                    bestPoint = result.point;
+                    found = true;
+                }
+            }
+        } else {
+            //для малого кол-ва точек - обычный поиск
+            found = findBestPoint(0, m_remainingPoints.size(), pb, pe, gamma, bestPoint, minArea);
+        }
+
+        if (found) {
+            //ёмкость зарезервирована, вставка и удаление без перевыделения
+            m_hull.insert(m_hull.begin() + maxSideIndex + 1, bestPoint);
+            auto it = std::find_if(m_remainingPoints.begin(), m_remainingPoints.end(),
+                [&bestPoint](const QPointF &p) {
+                    return std::abs(p.x() - bestPoint.x()) < 1e-9 &&
+                           std::abs(p.y() - bestPoint.y()) < 1e-9;
+                });
+            if (it != m_remainingPoints.end()) {
+                m_remainingPoints.erase(it);
+            }
+
+            changed = true;
+        }
+    }
+
+    copyInto(m_hull, concaveHull);
+}
+
+bool ConcaveHullEngine::findBestPoint(int begin, int end, const QPointF &pb, const QPointF &pe,
+                                      double gamma, QPointF &bestPoint, double &minArea) const
+{
+    bool found = false;
+    for (int j = begin; j < end; ++j) {
+        const QPointF &pi = m_remainingPoints[j];
+
+        //условие вогнутости
+        if (satisfiesConcaveCondition(pb, pe, pi, gamma)) {
+            //если треугольник не пересекается с текущей оболочкой
+            if (triangleDoesNotIntersectHull(pb, pe, pi, m_hull)) {
+                double area = triangleArea(pb, pe, pi);
+                if (area < minArea) {
+                    minArea = area;
+                    bestPoint = pi;
+                    found = true;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+void ConcaveHullEngine::grahamScan(const QVector<QPointF> &points, QVector<QPointF> &hull)
+{
+    copyInto(points, m_sortedPoints);
+
+    //нахождение самой нижней точки
+    int lowestIndex = findLowestPoint(m_sortedPoints);
+    std::swap(m_sortedPoints[0], m_sortedPoints[lowestIndex]);
+
+    //сортировка оставшихся точек по полярному углу
+    QPointF p0 = m_sortedPoints[0];
+    std::sort(m_sortedPoints.begin() + 1, m_sortedPoints.end(),
+        [p0](const QPointF &a, const QPointF &b) {
+            double orient = orientation(p0, a, b);
+            if (std::abs(orient) < 1e-9) {
+                //если коллинеарны, то сорт по дист
+                return distance(p0, a) < distance(p0, b);
+            }
+            return orient > 0;
+        });
+
+    //если точка дубликат - удалить
+    auto it = std::unique(m_sortedPoints.begin() + 1, m_sortedPoints.end(),
+        [p0](const QPointF &a, const QPointF &b) {
+            return std::abs(orientation(p0, a, b)) < 1e-9;
+        });
+    m_sortedPoints.erase(it, m_sortedPoints.end());
+
+    if (m_sortedPoints.size() < 3) {
+        copyInto(m_sortedPoints, hull);
+        return;
+    }
+
+    //строим выпуклую оболочку; стек хранится в начале m_sortedPoints,
+    //его вершина никогда не обгоняет текущий индекс
+    int top = 2;
+    for (int i = 2; i < m_sortedPoints.size(); ++i) {
+        const QPointF p = m_sortedPoints[i];
+        while (top > 1 && orientation(m_sortedPoints[top - 2], m_sortedPoints[top - 1], p) <= 0) {
+            --top;
+        }
+        m_sortedPoints[top++] = p;
+    }
+    m_sortedPoints.resize(top);
+
+    copyInto(m_sortedPoints, hull);
+}
+
+bool ConcaveHullEngine::satisfiesConcaveCondition(const QPointF &pb, const QPointF &pe,
+                                                  const QPointF &pi, double gamma)
+{
+    double d0 = distance(pb, pe);
+    double d1 = distance(pb, pi);
+    double d2 = distance(pe, pi);
+
+    //d1^2 + d2^2 - d0^2 < gamma * min(d1^2, d2^2)
+    double leftSide = d1 + d2 - d0;
+    double rightSide = gamma * std::min(d1, d2);
+
+    return leftSide < rightSide;
+}
+
+bool ConcaveHullEngine::segmentsIntersect(const QPointF &p1, const QPointF &p2,
+                                          const QPointF &p3, const QPointF &p4)
+{
+    double o1 = orientation(p1, p2, p3);
+    double o2 = orientation(p1, p2, p4);
+    double o3 = orientation(p3, p4, p1);
+    double o4 = orientation(p3, p4, p2);
+
+    //отрезки пересекаются, если ориентации разные
+    if (o1 != 0 && o2 != 0 && o3 != 0 && o4 != 0) {
+        return (o1 * o2 < 0) && (o3 * o4 < 0);
+    }
+
+    if (o1 == 0 && o2 == 0 && o3 == 0 && o4 == 0) {
+        //если все точки коллинеарны - проверяем перекрытие проекций
+        double minX1 = std::min(p1.x(), p2.x());
+        double maxX1 = std::max(p1.x(), p2.x());
+        double minX2 = std::min(p3.x(), p4.x());
+        double maxX2 = std::max(p3.x(), p4.x());
+
+        double minY1 = std::min(p1.y(), p2.y());
+        double maxY1 = std::max(p1.y(), p2.y());
+        double minY2 = std::min(p3.y(), p4.y());
+        double maxY2 = std::max(p3.y(), p4.y());
+
+        return !(maxX1 < minX2 || maxX2 < minX1 || maxY1 < minY2 || maxY2 < minY1);
+    }
+
+    return false;
+}
+
+bool ConcaveHullEngine::triangleDoesNotIntersectHull(const QPointF &pb, const QPointF &pe,
+                                                     const QPointF &pi, const QVector<QPointF> &hull)
+{
+    //если стороны треугольника не пересекаются с существующими сторонами оболочки
+    for (int i = 0; i < hull.size(); ++i) {
+        int next = (i + 1) % hull.size();
+
+        //пропускаем сторону, которую мы заменяем
+        if ((std::abs(hull[i].x() - pb.x()) < 1e-9 && std::abs(hull[i].y() - pb.y()) < 1e-9 &&
+             std::abs(hull[next].x() - pe.x()) < 1e-9 && std::abs(hull[next].y() - pe.y()) < 1e-9) ||
+            (std::abs(hull[i].x() - pe.x()) < 1e-9 && std::abs(hull[i].y() - pe.y()) < 1e-9 &&
+             std::abs(hull[next].x() - pb.x()) < 1e-9 && std::abs(hull[next].y() - pb.y()) < 1e-9)) {
+            continue;
+        }
+
+        //есть ли пересечение с новыми сторонами
+        if (segmentsIntersect(pb, pi, hull[i], hull[next]) ||
+            segmentsIntersect(pi, pe, hull[i], hull[next])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+double ConcaveHullEngine::triangleArea(const QPointF &p1, const QPointF &p2, const QPointF &p3)
+{
+    return std::abs((p2.x() - p1.x()) * (p3.y() - p1.y()) - (p3.x() - p1.x()) * (p2.y() - p1.y())) / 2.0;
+}
+
+double ConcaveHullEngine::orientation(const QPointF &p, const QPointF &q, const QPointF &r)
+{
+    return (q.x() - p.x()) * (r.y() - p.y()) - (q.y() - p.y()) * (r.x() - p.x());
+}
+
+double ConcaveHullEngine::distance(const QPointF &p1, const QPointF &p2)
+{
+    double dx = p2.x() - p1.x();
+    double dy = p2.y() - p1.y();
+    return dx * dx + dy * dy;
+}
+
+int ConcaveHullEngine::findLowestPoint(const QVector<QPointF> &points)
+{
+    int lowestIndex = 0;
+    for (int i = 1; i < points.size(); ++i) {
+        if (points[i].y() < points[lowestIndex].y() ||
+            (points[i].y() == points[lowestIndex].y() && points[i].x() < points[lowestIndex].x())) {
+            lowestIndex = i;
+        }
+    }
+    return lowestIndex;
+}
+
+void ConcaveHullEngine::copyInto(const QVector<QPointF> &src, QVector<QPointF> &dst)
+{
+    dst.resize(src.size());
+    std::copy(src.constBegin(), src.constEnd(), dst.begin());
+}
@@ -0,0 +1,104 @@
+#ifndef CONCAVEHULLENGINE_H
+#define CONCAVEHULLENGINE_H
+
+#include <QVector>
+#include <QPointF>
+#include <QString>
+
+//движок построения оболочек; все рабочие буферы выделяются один раз
+//в reserve() и переиспользуются между итерациями и повторными расчётами.
+//Потоки поиска общие на процесс, поэтому движок держит только буферы
+class ConcaveHullEngine
+{
+    Q_DISABLE_COPY(ConcaveHullEngine)
+
+private:
+    //общий на процесс набор постоянных потоков поиска лучшей точки
+    class SearchPool;
+
+    //участок и результат поиска одного потока
+    struct ThreadResult {
+        int begin;
+        int end;
+        QPointF point;
+        double area;
+    };
+
+    QVector<QPointF> m_sortedPoints;      //копия входа для сортировки в грэхеме
+    QVector<QPointF> m_hull;              //текущая оболочка в процессе уточнения
+    QVector<QPointF> m_remainingPoints;   //точки, ещё не вошедшие в оболочку
+    QVector<ThreadResult> m_threadResults;//участки и результаты по потокам
+    int m_numThreads;
+
+    //параметры текущего шага поиска, общие для всех потоков
+    QPointF m_searchPb;
+    QPointF m_searchPe;
+    double m_searchGamma;
+
+    //пул потоков поиска, создаётся при первом обращении
+    static SearchPool &searchPool();
+
+    //поиск на участке потока index; вызывается из потоков пула
+    void searchChunk(int index);
+
+    //алгоритм грэхема для построения выпуклой оболочки
+    void grahamScan(const QVector<QPointF> &points, QVector<QPointF> &hull);
+
+    //поиск точки с минимальной площадью треугольника на стороне pb-pe
+    bool findBestPoint(int begin, int end, const QPointF &pb, const QPointF &pe,
+                       double gamma, QPointF &bestPoint, double &minArea) const;
+
+    //проверка условия для добавления точки в вогнутую оболочку
+    static bool satisfiesConcaveCondition(const QPointF &pb, const QPointF &pe,
+                                          const QPointF &pi, double gamma);
+
+    //проверка пересечения отрезков
+    static bool segmentsIntersect(const QPointF &p1, const QPointF &p2,
+                                  const QPointF &p3, const QPointF &p4);
+
+    //проверка, что треугольник не пересекается с текущей оболочкой
+    static bool triangleDoesNotIntersectHull(const QPointF &pb, const QPointF &pe,
+                                             const QPointF &pi, const QVector<QPointF> &hull);
+
+    //вычисление площади треугольника
+    static double triangleArea(const QPointF &p1, const QPointF &p2, const QPointF &p3);
+
+    //вычисление ориентации трех точек
+    static double orientation(const QPointF &p, const QPointF &q, const QPointF &r);
+
+    //вычисление расстояния между двумя точками
+    static double distance(const QPointF &p1, const QPointF &p2);
+
+    //нахождение самой нижней точки
+    static int findLowestPoint(const QVector<QPointF> &points);
+
+    //копирование без перевыделения памяти, если ёмкости хватает
+    static void copyInto(const QVector<QPointF> &src, QVector<QPointF> &dst);
+
+public:
+    ConcaveHullEngine();
+
+    //чтение точек "x y" из текстового файла, некорректные строки пропускаются
+    static bool loadPoints(const QString &filename, QVector<QPointF> &points);
+
+    //резервирование рабочих буферов под заданное кол-во точек
+    void reserve(int pointCount);
+
+    //объём памяти рабочих буферов, байт
+    qint64 bufferBytes() const;
+
+    //освобождение буферов, ёмкость которых больше pointCount точек;
+    //возвращает освобождённый объём, байт
+    qint64 shrink(int pointCount);
+
+    //построение выпуклой оболочки в convexHull
+    void buildConvexHull(const QVector<QPointF> &points, QVector<QPointF> &convexHull);
+
+    //построение вогнутой оболочки в concaveHull
+    void buildConcaveHull(const QVector<QPointF> &convexHull,
+                          const QVector<QPointF> &allPoints,
+                          double gamma,
+                          QVector<QPointF> &concaveHull);
+};
+
+#endif // CONCAVEHULLENGINE_H
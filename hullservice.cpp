@@ -0,0 +1,582 @@
+#include "hullservice.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QMutexLocker>
+#include <QPolygonF>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
+//сколько вогнутых оболочек с разными gamma хранится на один набор
+static const int kMaxCachedGammas = 32;
+
+//сколько движков держит пул; построение и так параллельно внутри движка
+static const int kMaxEngines = 2;
+
+HullService::HullService(qint64 memoryBudget)
+    : m_memoryBudget(memoryBudget)
+    , m_usedBytes(0)
+    , m_engineBytes(0)
+    , m_cacheHits(0)
+    , m_cacheMisses(0)
+    , m_evictions(0)
+    , m_engineCount(0)
+{
+    m_buildPool.setMaxThreadCount(kMaxEngines);
+}
+
+HullService::~HullService()
+{
+    m_requestPool.waitForDone();
+    m_buildPool.waitForDone();
+    qDeleteAll(m_idleEngines);
+}
+
+bool HullService::parseMemoryBudget(const QByteArray &value, qint64 *bytes)
+{
+    bool ok = false;
+    const qint64 megabytes = value.toLongLong(&ok);
+    if (!ok || megabytes <= 0 || megabytes > (std::numeric_limits<qint64>::max() >> 20)) {
+        return false;
+    }
+    *bytes = megabytes << 20;
+    return true;
+}
+
+int HullService::run()
+{
+    QFile input;
+    if (!input.open(stdin, QIODevice::ReadOnly)) {
+        return 1;
+    }
+
+    while (true) {
+        QByteArray line = input.readLine();
+        if (line.isEmpty()) {
+            break;
+        }
+        line = line.trimmed();
+        if (line.isEmpty()) continue;
+
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+        if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+            QJsonObject response = error("Некорректный JSON: " + parseError.errorString());
+            writeResponse(QJsonDocument(response).toJson(QJsonDocument::Compact));
+            continue;
+        }
+
+        const QJsonObject request = doc.object();
+        const QString id = request.value("dataset").toString();
+
+        //запросы без набора ни от чего не зависят, ответы сопоставляются по полю "id"
+        if (id.isEmpty()) {
+            QtConcurrent::run(&m_requestPool, [this, request]() {
+                respond(request);
+            });
+            continue;
+        }
+
+        QMutexLocker locker(&m_laneMutex);
+        m_lanes[id].pending.enqueue(request);
+        scheduleLane(id);
+    }
+
+    //запросы из пулов могут ещё ставить в очередь следующие запросы своих наборов
+    while (true) {
+        m_requestPool.waitForDone();
+        m_buildPool.waitForDone();
+        QMutexLocker locker(&m_laneMutex);
+        if (m_lanes.isEmpty()) {
+            break;
+        }
+    }
+    return 0;
+}
+
+void HullService::scheduleLane(const QString &id)
+{
+    auto it = m_lanes.find(id);
+    if (it == m_lanes.end()) {
+        return;
+    }
+
+    Lane &lane = it.value();
+    while (!lane.pending.isEmpty() && !lane.barrierRunning) {
+        const bool barrier = isBarrier(lane.pending.head());
+        //барьер ждёт завершения всех запросов перед ним
+        if (barrier && lane.running > 0) {
+            break;
+        }
+
+        const QJsonObject request = lane.pending.dequeue();
+        ++lane.running;
+        lane.barrierRunning = barrier;
+        QtConcurrent::run(poolFor(request), [this, id, request, barrier]() {
+            runLaneRequest(id, request, barrier);
+        });
+    }
+
+    if (lane.pending.isEmpty() && lane.running == 0) {
+        m_lanes.erase(it);
+    }
+}
+
+void HullService::runLaneRequest(const QString &id, const QJsonObject &request, bool barrier)
+{
+    respond(request);
+
+    QMutexLocker locker(&m_laneMutex);
+    Lane &lane = m_lanes[id];
+    --lane.running;
+    if (barrier) {
+        lane.barrierRunning = false;
+    }
+    scheduleLane(id);
+}
+
+void HullService::respond(const QJsonObject &request)
+{
+    writeResponse(handleRequest(request));
+}
+
+QThreadPool *HullService::poolFor(const QJsonObject &request)
+{
+    const QString op = request.value("op").toString();
+    if (op == "load") {
+        return &m_buildPool;
+    }
+
+    const bool concave = op == "concave" || (op == "contains" && request.contains("gamma"));
+    if (!concave || !request.value("gamma").isDouble()) {
+        return &m_requestPool;
+    }
+
+    //промах кэша означает построение оболочки; состояние кэша может
+    //измениться до выполнения, но это влияет только на выбор пула
+    DatasetPtr dataset;
+    {
+        QMutexLocker locker(&m_mutex);
+        dataset = m_datasets.value(request.value("dataset").toString());
+    }
+    if (!dataset || dataset->convexHull.size() < 3) {
+        return &m_requestPool;
+    }
+
+    const double gamma = clampGamma(request.value("gamma").toDouble());
+    QMutexLocker locker(&dataset->cacheMutex);
+    return dataset->concaveCache.contains(gamma) ? &m_requestPool : &m_buildPool;
+}
+
+double HullService::clampGamma(double gamma)
+{
+    if (gamma < 0.0) gamma = 0.0;
+    if (gamma > 2.0) gamma = 2.0;
+    return gamma;
+}
+
+bool HullService::isBarrier(const QJsonObject &request)
+{
+    const QString op = request.value("op").toString();
+    return op == "load" || op == "unload";
+}
+
+QByteArray HullService::handleRequest(const QJsonObject &request)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QJsonObject response;
+    const QString op = request.value("op").toString();
+
+    if (op == "load") {
+        response = handleLoad(request);
+    } else if (op == "concave") {
+        response = handleConcave(request);
+    } else if (op == "contains") {
+        response = handleContains(request);
+    } else if (op == "stats") {
+        response = handleStats(request);
+    } else if (op == "unload") {
+        response = handleUnload(request);
+    } else {
+        response = error("Неизвестная команда: " + op);
+    }
+
+    if (request.contains("id")) {
+        response.insert("id", request.value("id"));
+    }
+
+    response.insert("elapsedUs", static_cast<double>(timer.nsecsElapsed() / 1000));
+    return QJsonDocument(response).toJson(QJsonDocument::Compact);
+}
+
+QJsonObject HullService::handleLoad(const QJsonObject &request)
+{
+    const QString id = request.value("dataset").toString();
+    const QString file = request.value("file").toString();
+    if (id.isEmpty() || file.isEmpty()) {
+        return error("Нужны поля dataset и file");
+    }
+
+    //разбор файла и выпуклая оболочка строятся вне общей блокировки
+    DatasetPtr dataset(new Dataset);
+    dataset->id = id;
+    if (!ConcaveHullEngine::loadPoints(file, dataset->points)) {
+        return error("Не удалось открыть файл: " + file);
+    }
+    if (dataset->points.isEmpty()) {
+        return error("Файл не содержит корректных точек");
+    }
+
+    ConcaveHullEngine *engine = checkoutEngine(dataset->points.size());
+    engine->buildConvexHull(dataset->points, dataset->convexHull);
+    returnEngine(engine);
+    dataset->bytes = estimateBytes(*dataset);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        DatasetPtr previous = m_datasets.value(id);
+        if (previous) {
+            m_usedBytes -= previous->bytes;
+            m_lru.removeOne(id);
+        }
+        m_datasets.insert(id, dataset);
+        m_lru.prepend(id);
+        m_usedBytes += dataset->bytes;
+        evictOverBudget();
+    }
+    trimEngines();
+
+    QJsonObject response;
+    response.insert("ok", true);
+    response.insert("dataset", id);
+    response.insert("points", dataset->points.size());
+    response.insert("convexHull", dataset->convexHull.size());
+    return response;
+}
+
+QJsonObject HullService::handleConcave(const QJsonObject &request)
+{
+    DatasetPtr dataset = acquire(request.value("dataset").toString());
+    if (!dataset) {
+        return error("Набор не загружен");
+    }
+
+    if (!request.value("gamma").isDouble()) {
+        return error("Нужно поле gamma");
+    }
+
+    bool cached = false;
+    const QVector<QPointF> hull = concaveHull(dataset, request.value("gamma").toDouble(), &cached);
+
+    QJsonArray points;
+    for (const QPointF &p : hull) {
+        points.append(QJsonArray{p.x(), p.y()});
+    }
+
+    QJsonObject response;
+    response.insert("ok", true);
+    response.insert("cached", cached);
+    response.insert("hull", points);
+    return response;
+}
+
+QJsonObject HullService::handleContains(const QJsonObject &request)
+{
+    DatasetPtr dataset = acquire(request.value("dataset").toString());
+    if (!dataset) {
+        return error("Набор не загружен");
+    }
+    if (!request.value("x").isDouble() || !request.value("y").isDouble()) {
+        return error("Нужны поля x и y");
+    }
+    if (request.contains("gamma") && !request.value("gamma").isDouble()) {
+        return error("Поле gamma должно быть числом");
+    }
+
+    //без gamma проверяем по выпуклой оболочке, иначе по вогнутой
+    bool cached = true;
+    const QVector<QPointF> hull = request.contains("gamma")
+            ? concaveHull(dataset, request.value("gamma").toDouble(), &cached)
+            : dataset->convexHull;
+
+    const QPointF point(request.value("x").toDouble(), request.value("y").toDouble());
+    const bool inside = hull.size() >= 3 && QPolygonF(hull).containsPoint(point, Qt::OddEvenFill);
+
+    QJsonObject response;
+    response.insert("ok", true);
+    response.insert("cached", cached);
+    response.insert("inside", inside);
+    return response;
+}
+
+QJsonObject HullService::handleStats(const QJsonObject &request)
+{
+    QJsonObject response;
+    response.insert("ok", true);
+
+    const QString id = request.value("dataset").toString();
+    if (!id.isEmpty()) {
+        DatasetPtr dataset = acquire(id);
+        if (!dataset) {
+            return error("Набор не загружен");
+        }
+
+        qint64 bytes;
+        {
+            QMutexLocker locker(&m_mutex);
+            bytes = dataset->bytes;
+        }
+
+        QJsonArray gammas;
+        {
+            QMutexLocker locker(&dataset->cacheMutex);
+            for (double gamma : dataset->concaveCache.keys()) {
+                gammas.append(gamma);
+            }
+        }
+        response.insert("dataset", id);
+        response.insert("points", dataset->points.size());
+        response.insert("convexHull", dataset->convexHull.size());
+        response.insert("cachedGammas", gammas);
+        response.insert("bytes", static_cast<double>(bytes));
+        return response;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    response.insert("datasets", QJsonArray::fromStringList(m_lru));
+    response.insert("usedBytes", static_cast<double>(m_usedBytes));
+    response.insert("engineBytes", static_cast<double>(m_engineBytes));
+    response.insert("memoryBudget", static_cast<double>(m_memoryBudget));
+    response.insert("cacheHits", static_cast<double>(m_cacheHits));
+    response.insert("cacheMisses", static_cast<double>(m_cacheMisses));
+    response.insert("evictions", static_cast<double>(m_evictions));
+    return response;
+}
+
+QJsonObject HullService::handleUnload(const QJsonObject &request)
+{
+    const QString id = request.value("dataset").toString();
+
+    QMutexLocker locker(&m_mutex);
+    DatasetPtr dataset = m_datasets.take(id);
+    if (!dataset) {
+        return error("Набор не загружен");
+    }
+    m_lru.removeOne(id);
+    m_usedBytes -= dataset->bytes;
+    locker.unlock();
+
+    trimEngines();
+
+    QJsonObject response;
+    response.insert("ok", true);
+    return response;
+}
+
+HullService::DatasetPtr HullService::acquire(const QString &id)
+{
+    QMutexLocker locker(&m_mutex);
+    DatasetPtr dataset = m_datasets.value(id);
+    if (dataset && m_lru.first() != id) {
+        m_lru.removeOne(id);
+        m_lru.prepend(id);
+    }
+    return dataset;
+}
+
+ConcaveHullEngine *HullService::checkoutEngine(int pointCount)
+{
+    QMutexLocker locker(&m_engineMutex);
+    while (m_idleEngines.isEmpty() && m_engineCount >= kMaxEngines) {
+        m_engineAvailable.wait(&m_engineMutex);
+    }
+
+    ConcaveHullEngine *engine;
+    if (!m_idleEngines.isEmpty()) {
+        engine = m_idleEngines.takeLast();
+    } else {
+        engine = new ConcaveHullEngine;
+        ++m_engineCount;
+    }
+    locker.unlock();
+
+    //рост буферов учитывается в общем бюджете памяти
+    const qint64 before = engine->bufferBytes();
+    engine->reserve(pointCount);
+    const qint64 grown = engine->bufferBytes() - before;
+    if (grown > 0) {
+        QMutexLocker usedLocker(&m_mutex);
+        m_usedBytes += grown;
+        m_engineBytes += grown;
+        evictOverBudget();
+    }
+    return engine;
+}
+
+void HullService::returnEngine(ConcaveHullEngine *engine)
+{
+    //ужимать здесь нельзя: при load набор ещё не добавлен в m_datasets,
+    //поэтому trimEngines вызывается после изменения состава наборов
+    QMutexLocker locker(&m_engineMutex);
+    m_idleEngines.append(engine);
+    m_engineAvailable.wakeOne();
+}
+
+void HullService::trimEngines()
+{
+    int largest = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const DatasetPtr &dataset : m_datasets) {
+            largest = std::max(largest, dataset->points.size());
+        }
+    }
+
+    qint64 freed = 0;
+    {
+        QMutexLocker locker(&m_engineMutex);
+        for (ConcaveHullEngine *engine : m_idleEngines) {
+            freed += engine->shrink(largest);
+        }
+    }
+
+    if (freed > 0) {
+        QMutexLocker locker(&m_mutex);
+        m_usedBytes -= freed;
+        m_engineBytes -= freed;
+    }
+}
+
+QVector<QPointF> HullService::concaveHull(const DatasetPtr &dataset, double gamma, bool *cached)
+{
+    gamma = clampGamma(gamma);
+
+    //кэш проверяется под короткой блокировкой, чтобы попадания
+    //не ждали построения других оболочек этого набора
+    QVector<QPointF> hull;
+    {
+        QMutexLocker locker(&dataset->cacheMutex);
+        auto it = dataset->concaveCache.constFind(gamma);
+        *cached = it != dataset->concaveCache.constEnd();
+        if (*cached) {
+            hull = it.value();
+            if (dataset->gammaLru.first() != gamma) {
+                dataset->gammaLru.removeOne(gamma);
+                dataset->gammaLru.prepend(gamma);
+            }
+        }
+    }
+    {
+        QMutexLocker locker(&m_mutex);
+        if (*cached) {
+            ++m_cacheHits;
+        } else {
+            ++m_cacheMisses;
+        }
+    }
+    if (*cached) {
+        return hull;
+    }
+
+    if (dataset->convexHull.size() < 3) {
+        hull = dataset->convexHull;
+    } else {
+        ConcaveHullEngine *engine = checkoutEngine(dataset->points.size());
+        engine->buildConcaveHull(dataset->convexHull, dataset->points, gamma, hull);
+        returnEngine(engine);
+    }
+
+    {
+        QMutexLocker locker(&dataset->cacheMutex);
+        //ту же gamma мог параллельно посчитать другой запрос
+        if (!dataset->concaveCache.contains(gamma)) {
+            dataset->concaveCache.insert(gamma, hull);
+            dataset->gammaLru.prepend(gamma);
+            while (dataset->gammaLru.size() > kMaxCachedGammas) {
+                dataset->concaveCache.remove(dataset->gammaLru.takeLast());
+            }
+        }
+    }
+    updateFootprint(dataset.data());
+    trimEngines();
+    return hull;
+}
+
+void HullService::updateFootprint(Dataset *dataset)
+{
+    //порядок блокировок везде один: m_mutex, затем cacheMutex набора
+    QMutexLocker locker(&m_mutex);
+    qint64 bytes;
+    {
+        QMutexLocker cacheLocker(&dataset->cacheMutex);
+        bytes = estimateBytes(*dataset);
+    }
+
+    //набор мог быть вытеснен или заменён, пока шёл расчёт
+    if (m_datasets.value(dataset->id).data() == dataset) {
+        m_usedBytes += bytes - dataset->bytes;
+    }
+    dataset->bytes = bytes;
+    evictOverBudget();
+}
+
+void HullService::evictOverBudget()
+{
+    //последний использованный набор не вытесняется, даже если он один больше лимита
+    while (m_usedBytes > m_memoryBudget && m_lru.size() > 1) {
+        const QString id = m_lru.takeLast();
+        DatasetPtr dataset = m_datasets.take(id);
+        if (dataset) {
+            m_usedBytes -= dataset->bytes;
+        }
+        ++m_evictions;
+    }
+
+    //единственный набор больше лимита: освобождаем его кэш вогнутых оболочек
+    if (m_usedBytes > m_memoryBudget && !m_lru.isEmpty()) {
+        DatasetPtr dataset = m_datasets.value(m_lru.first());
+        if (!dataset) {
+            return;
+        }
+
+        QMutexLocker locker(&dataset->cacheMutex);
+        while (m_usedBytes > m_memoryBudget && !dataset->gammaLru.isEmpty()) {
+            const QVector<QPointF> hull = dataset->concaveCache.take(dataset->gammaLru.takeLast());
+            const qint64 bytes = hull.size() * static_cast<qint64>(sizeof(QPointF));
+            dataset->bytes -= bytes;
+            m_usedBytes -= bytes;
+        }
+    }
+}
+
+void HullService::writeResponse(const QByteArray &line)
+{
+    QMutexLocker locker(&m_outputMutex);
+    std::fwrite(line.constData(), 1, line.size(), stdout);
+    std::fputc('\n', stdout);
+    std::fflush(stdout);
+}
+
+qint64 HullService::estimateBytes(const Dataset &dataset)
+{
+    //только данные набора: рабочие буферы движков общие и в бюджет не входят
+    qint64 count = dataset.points.size() + dataset.convexHull.size();
+    for (const QVector<QPointF> &hull : dataset.concaveCache) {
+        count += hull.size();
+    }
+    return count * static_cast<qint64>(sizeof(QPointF));
+}
+
+QJsonObject HullService::error(const QString &message)
+{
+    QJsonObject response;
+    response.insert("ok", false);
+    response.insert("error", message);
+    return response;
+}
@@ -0,0 +1,134 @@
+#ifndef HULLSERVICE_H
+#define HULLSERVICE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QPointF>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+#include "concavehullengine.h"
+
+//резидентный сервис без GUI: держит наборы точек и построенные оболочки
+//в памяти и отвечает на запросы в формате JSON, по одному на строку
+class HullService
+{
+private:
+    //загруженный набор точек со всем, что по нему уже посчитано;
+    //points и convexHull после загрузки не меняются
+    struct Dataset {
+        QString id;
+        QVector<QPointF> points;
+        QVector<QPointF> convexHull;
+        QMutex cacheMutex;                           //защищает concaveCache, держится недолго
+        QMap<double, QVector<QPointF>> concaveCache; //вогнутые оболочки по gamma
+        QList<double> gammaLru;                      //gamma из кэша, первым - последний использованный
+        qint64 bytes = 0;                            //оценка занимаемой памяти, под m_mutex
+    };
+    typedef QSharedPointer<Dataset> DatasetPtr;
+
+    qint64 m_memoryBudget;                   //лимит памяти на все наборы, байт
+    QMutex m_mutex;                          //защищает поля ниже
+    QHash<QString, DatasetPtr> m_datasets;   //наборы по id
+    QStringList m_lru;                       //id наборов, первым - последний использованный
+    qint64 m_usedBytes;                      //наборы и буферы движков
+    qint64 m_engineBytes;                    //из них буферы движков
+    qint64 m_cacheHits;
+    qint64 m_cacheMisses;
+    qint64 m_evictions;
+
+    //очередь запросов к одному набору: load и unload выполняются как барьеры,
+    //остальные запросы между барьерами идут параллельно
+    struct Lane {
+        QQueue<QJsonObject> pending;
+        int running = 0;
+        bool barrierRunning = false;
+    };
+    QMutex m_laneMutex;                      //защищает m_lanes
+    QHash<QString, Lane> m_lanes;            //очереди по id набора
+
+    //небольшой общий пул движков вместо движка на каждый набор; их буферы
+    //входят в m_usedBytes и ужимаются, когда крупные наборы выгружены
+    QMutex m_engineMutex;                    //защищает поля пула ниже
+    QWaitCondition m_engineAvailable;
+    QVector<ConcaveHullEngine *> m_idleEngines;
+    int m_engineCount;
+
+    QMutex m_outputMutex;                    //сериализует запись ответов
+    QThreadPool m_requestPool;               //быстрые запросы: попадания в кэш, stats, unload
+    QThreadPool m_buildPool;                 //load и построение оболочек, по потоку на движок
+
+    //обработчики отдельных команд
+    QJsonObject handleLoad(const QJsonObject &request);
+    QJsonObject handleConcave(const QJsonObject &request);
+    QJsonObject handleContains(const QJsonObject &request);
+    QJsonObject handleStats(const QJsonObject &request);
+    QJsonObject handleUnload(const QJsonObject &request);
+
+    //запуск всех запросов набора, которым уже можно выполняться; под m_laneMutex
+    void scheduleLane(const QString &id);
+
+    //обработка запроса из очереди набора и запуск следующих
+    void runLaneRequest(const QString &id, const QJsonObject &request, bool barrier);
+
+    //запись ответа на запрос
+    void respond(const QJsonObject &request);
+
+    static bool isBarrier(const QJsonObject &request);
+
+    //пул для запроса: тяжёлые запросы не занимают потоки быстрых
+    QThreadPool *poolFor(const QJsonObject &request);
+
+    static double clampGamma(double gamma);
+
+    //поиск набора по id с отметкой об использовании
+    DatasetPtr acquire(const QString &id);
+
+    //взять свободный движок из пула, зарезервировав его под pointCount точек
+    ConcaveHullEngine *checkoutEngine(int pointCount);
+    void returnEngine(ConcaveHullEngine *engine);
+
+    //ужать свободные движки до самого большого из загруженных наборов
+    void trimEngines();
+
+    //вогнутая оболочка из кэша или построенная заново
+    QVector<QPointF> concaveHull(const DatasetPtr &dataset, double gamma, bool *cached);
+
+    //пересчёт занимаемой набором памяти
+    void updateFootprint(Dataset *dataset);
+
+    //вытеснение давно не использованных наборов сверх лимита, а если остался
+    //один набор - его старых вогнутых оболочек; под m_mutex
+    void evictOverBudget();
+
+    //запись строки ответа в stdout
+    void writeResponse(const QByteArray &line);
+
+    static qint64 estimateBytes(const Dataset &dataset);
+    static QJsonObject error(const QString &message);
+
+public:
+    explicit HullService(qint64 memoryBudget);
+    ~HullService();
+
+    //разбор значения --memory-budget в мегабайтах; false, если это
+    //не положительное число или оно не помещается в байтах
+    static bool parseMemoryBudget(const QByteArray &value, qint64 *bytes);
+
+    //обработка одного запроса, потокобезопасна
+    QByteArray handleRequest(const QJsonObject &request);
+
+    //чтение запросов из stdin до EOF; запросы к одному набору выполняются
+    //в порядке поступления относительно load/unload, к разным - параллельно
+    int run();
+};
+
+#endif // HULLSERVICE_H
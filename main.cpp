@@ -1,10 +1,40 @@
 #include <QApplication>
 #include <QMessageBox>
 #include <QDebug>
+#include <QCoreApplication>
+#include <cstring>
+#include <cstdio>
 #include "mainwindow.h"
+#include "hullservice.h"
+
+//режим сервиса: Task3 --server [--memory-budget МБ]
+static int runServer(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    qint64 budget = qint64(512) << 20;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--memory-budget") == 0) {
+            if (i + 1 >= argc || !HullService::parseMemoryBudget(argv[i + 1], &budget)) {
+                std::fprintf(stderr, "--memory-budget: ожидается положительное число МБ\n");
+                return 2;
+            }
+            ++i;
+        }
+    }
+
+    HullService service(budget);
+    return service.run();
+}
 
 int main(int argc, char *argv[])
 {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--server") == 0) {
+            return runServer(argc, argv);
+        }
+    }
+
     try {
         QApplication app(argc, argv);
         MainWindow window;
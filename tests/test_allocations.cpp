@@ -0,0 +1,169 @@
+#include <QPointF>
+#include <QVector>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include "concavehullengine.h"
+
+//счётчик выделений памяти: замена глобального operator new, а на glibc
+//ещё и malloc, через который выделяют память контейнеры Qt
+static std::atomic<bool> g_counting(false);
+static std::atomic<long> g_allocations(0);
+
+static void countAllocation()
+{
+    if (g_counting.load(std::memory_order_relaxed)) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(size_t size)
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    countAllocation();
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+}
+
+//operator new идёт мимо подменённого malloc, чтобы не считать выделение дважды
+static void *rawMalloc(size_t size) { return __libc_malloc(size); }
+static void rawFree(void *ptr) { __libc_free(ptr); }
+#else
+static void *rawMalloc(size_t size) { return std::malloc(size); }
+static void rawFree(void *ptr) { std::free(ptr); }
+#endif
+
+void *operator new(size_t size)
+{
+    countAllocation();
+    if (void *ptr = rawMalloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    rawFree(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    rawFree(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    rawFree(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    rawFree(ptr);
+}
+
+//детерминированный набор точек: кольцо с шумом, чтобы было что вдавливать
+static QVector<QPointF> makePoints(int count)
+{
+    QVector<QPointF> points;
+    points.reserve(count);
+    unsigned int seed = 12345;
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        double angle = (seed % 10000) / 10000.0 * 2.0 * std::acos(-1.0);
+        seed = seed * 1103515245u + 12345u;
+        double radius = 50.0 + (seed % 10000) / 10000.0 * 50.0;
+        points.append(QPointF(radius * std::cos(angle), radius * std::sin(angle)));
+    }
+    return points;
+}
+
+int main()
+{
+    const QVector<QPointF> points = makePoints(300);
+    const double gammas[] = {0.0, 0.5, 1.0, 2.0};
+    const int gammaCount = sizeof(gammas) / sizeof(gammas[0]);
+
+    //эталонные оболочки строит отдельный движок, чтобы замер начинался
+    //с первого расчёта после reserve(); он же запускает общие потоки поиска
+    QVector<QVector<QPointF>> expected;
+    QVector<QPointF> expectedConvexHull;
+    {
+        ConcaveHullEngine reference;
+        reference.buildConvexHull(points, expectedConvexHull);
+        for (double gamma : gammas) {
+            QVector<QPointF> hull;
+            reference.buildConcaveHull(expectedConvexHull, points, gamma, hull);
+            expected.append(hull);
+        }
+    }
+
+    ConcaveHullEngine engine;
+    engine.reserve(points.size());
+
+    QVector<QPointF> convexHull;
+    QVector<QPointF> concaveHull;
+    convexHull.reserve(points.size());
+    concaveHull.reserve(points.size());
+
+    g_allocations = 0;
+    g_counting = true;
+    bool sameResults = true;
+    for (int round = 0; round < 3; ++round) {
+        engine.buildConvexHull(points, convexHull);
+        sameResults = sameResults && convexHull == expectedConvexHull;
+        for (int i = 0; i < gammaCount; ++i) {
+            engine.buildConcaveHull(convexHull, points, gammas[i], concaveHull);
+            sameResults = sameResults && concaveHull == expected.at(i);
+        }
+    }
+    g_counting = false;
+
+    const long allocations = g_allocations.load();
+    std::printf("convex hull: %d, concave hull (gamma 2): %d, allocations: %ld\n",
+                convexHull.size(), concaveHull.size(), allocations);
+
+    if (!sameResults) {
+        std::printf("FAIL: repeated runs give different hulls\n");
+        return 1;
+    }
+    if (concaveHull.size() <= convexHull.size()) {
+        std::printf("FAIL: concave hull was not refined\n");
+        return 1;
+    }
+    if (allocations != 0) {
+        std::printf("FAIL: heap allocations in steady state\n");
+        return 1;
+    }
+    return 0;
+}
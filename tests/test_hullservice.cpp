@@ -0,0 +1,198 @@
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPointF>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVector>
+#include <cmath>
+#include <cstdio>
+#include "hullservice.h"
+
+static int g_failures = 0;
+
+static void check(bool condition, const char *what)
+{
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        ++g_failures;
+    }
+}
+
+//детерминированный набор точек: кольцо с шумом
+static QString writePoints(const QTemporaryDir &dir, const QString &name, int count, unsigned int seed)
+{
+    const QString path = dir.filePath(name);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return path;
+    }
+
+    QTextStream out(&file);
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        double angle = (seed % 10000) / 10000.0 * 2.0 * std::acos(-1.0);
+        seed = seed * 1103515245u + 12345u;
+        double radius = 50.0 + (seed % 10000) / 10000.0 * 50.0;
+        out << radius * std::cos(angle) << " " << radius * std::sin(angle) << "\n";
+    }
+    return path;
+}
+
+static QJsonObject call(HullService &service, const QJsonObject &request)
+{
+    return QJsonDocument::fromJson(service.handleRequest(request)).object();
+}
+
+static QJsonObject load(HullService &service, const QString &id, const QString &file)
+{
+    return call(service, QJsonObject{{"op", "load"}, {"dataset", id}, {"file", file}});
+}
+
+static QJsonObject concave(HullService &service, const QString &id, double gamma)
+{
+    return call(service, QJsonObject{{"op", "concave"}, {"dataset", id}, {"gamma", gamma}});
+}
+
+static QJsonObject stats(HullService &service, const QString &id = QString())
+{
+    QJsonObject request{{"op", "stats"}};
+    if (!id.isEmpty()) {
+        request.insert("dataset", id);
+    }
+    return call(service, request);
+}
+
+//load -> concave (промах, затем попадание) -> unload
+static void testCacheAndUnload(const QTemporaryDir &dir)
+{
+    HullService service(qint64(64) << 20);
+    const QString file = writePoints(dir, "a.txt", 200, 1);
+
+    QJsonObject response = load(service, "a", file);
+    check(response.value("ok").toBool(), "load a");
+    check(response.value("points").toInt() == 200, "load a: points");
+
+    response = concave(service, "a", 0.5);
+    check(response.value("ok").toBool(), "concave a: ok");
+    check(!response.value("cached").toBool(), "concave a: first call is a miss");
+    const QJsonArray hull = response.value("hull").toArray();
+    check(hull.size() >= 3, "concave a: hull");
+
+    response = concave(service, "a", 0.5);
+    check(response.value("cached").toBool(), "concave a: second call is a hit");
+    check(response.value("hull").toArray() == hull, "concave a: cached hull is the same");
+
+    response = call(service, QJsonObject{{"op", "unload"}, {"dataset", "a"}});
+    check(response.value("ok").toBool(), "unload a");
+
+    response = concave(service, "a", 0.5);
+    check(!response.value("ok").toBool(), "concave after unload fails");
+    check(response.value("error").toString() == "Набор не загружен", "concave after unload: error");
+}
+
+//маленький бюджет вытесняет давно не использованный набор
+static void testEviction(const QTemporaryDir &dir)
+{
+    const QString fileA = writePoints(dir, "ea.txt", 200, 2);
+    const QString fileB = writePoints(dir, "eb.txt", 200, 3);
+    const QString fileC = writePoints(dir, "ec.txt", 200, 4);
+
+    //пробный прогон без ограничения: сколько занимают a, b и c
+    qint64 usedBeforeC;
+    qint64 bytesC;
+    {
+        HullService probe(qint64(64) << 20);
+        load(probe, "a", fileA);
+        load(probe, "b", fileB);
+        concave(probe, "a", 0.5);
+        usedBeforeC = static_cast<qint64>(stats(probe).value("usedBytes").toDouble());
+        load(probe, "c", fileC);
+        bytesC = static_cast<qint64>(stats(probe, "c").value("bytes").toDouble());
+    }
+
+    //c помещается, только если вытеснить b
+    HullService service(usedBeforeC + bytesC - 1);
+    load(service, "a", fileA);
+    load(service, "b", fileB);
+    concave(service, "a", 0.5);
+    check(load(service, "c", fileC).value("ok").toBool(), "eviction: load c");
+
+    const QJsonObject response = stats(service);
+    const QJsonArray datasets = response.value("datasets").toArray();
+    check(datasets == QJsonArray({"c", "a"}), "eviction: b is evicted, c and a stay");
+    check(response.value("evictions").toInt() == 1, "eviction: one eviction");
+    check(response.value("usedBytes").toDouble() <= response.value("memoryBudget").toDouble(),
+          "eviction: within budget");
+    check(!concave(service, "b", 0.5).value("ok").toBool(), "eviction: b is not loaded");
+    check(concave(service, "a", 0.5).value("cached").toBool(), "eviction: a keeps its cache");
+}
+
+//больше 32 разных gamma на одном наборе
+static void testGammaCacheLimit(const QTemporaryDir &dir)
+{
+    HullService service(qint64(64) << 20);
+    load(service, "d", writePoints(dir, "d.txt", 150, 5));
+
+    const int count = 40;
+    for (int i = 0; i < count; ++i) {
+        concave(service, "d", i * 0.05);
+    }
+
+    const QJsonArray gammas = stats(service, "d").value("cachedGammas").toArray();
+    check(gammas.size() == 32, "gamma cache: at most 32 entries");
+    check(!gammas.contains(0.0), "gamma cache: oldest gamma is dropped");
+    check(gammas.contains((count - 1) * 0.05), "gamma cache: newest gamma stays");
+    check(!concave(service, "d", 0.0).value("cached").toBool(), "gamma cache: dropped gamma is rebuilt");
+}
+
+//некорректные запросы и аргументы
+static void testValidation(const QTemporaryDir &dir)
+{
+    HullService service(qint64(64) << 20);
+    load(service, "e", writePoints(dir, "e.txt", 50, 6));
+
+    QJsonObject response = call(service, QJsonObject{{"op", "concave"}, {"dataset", "e"}});
+    check(!response.value("ok").toBool(), "concave without gamma fails");
+
+    response = call(service, QJsonObject{{"op", "contains"}, {"dataset", "e"}, {"x", "abc"}, {"y", 0.0}});
+    check(!response.value("ok").toBool(), "contains with non-numeric x fails");
+
+    response = call(service, QJsonObject{{"op", "contains"}, {"dataset", "e"}, {"x", 0.0}, {"y", 0.0}});
+    check(response.value("ok").toBool(), "contains: ok");
+    check(response.value("inside").toBool(), "contains: ring center is inside the convex hull");
+
+    response = call(service, QJsonObject{{"op", "frobnicate"}, {"id", 7}});
+    check(!response.value("ok").toBool(), "unknown op fails");
+    check(response.value("id").toInt() == 7, "unknown op: id is echoed");
+
+    qint64 bytes = -1;
+    check(!HullService::parseMemoryBudget("abc", &bytes), "budget: abc is rejected");
+    check(!HullService::parseMemoryBudget("0", &bytes), "budget: 0 is rejected");
+    check(!HullService::parseMemoryBudget("-5", &bytes), "budget: negative is rejected");
+    check(!HullService::parseMemoryBudget("", &bytes), "budget: empty is rejected");
+    check(!HullService::parseMemoryBudget("99999999999999999", &bytes), "budget: overflow is rejected");
+    check(bytes == -1, "budget: rejected value is not stored");
+    check(HullService::parseMemoryBudget("64", &bytes) && bytes == (qint64(64) << 20), "budget: 64 MB");
+}
+
+int main()
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        std::printf("FAIL: temporary directory\n");
+        return 1;
+    }
+
+    testCacheAndUnload(dir);
+    testEviction(dir);
+    testGammaCacheLimit(dir);
+    testValidation(dir);
+
+    if (g_failures != 0) {
+        std::printf("%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    return 0;
+}